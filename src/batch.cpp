@@ -0,0 +1,182 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "impl.h"
+#include "matrix.h"
+#include "queue.h"
+#include "util.h"
+
+// Number of problems that may wait between two pipeline stages.
+#define QUEUE_CAPACITY 256
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+enum Status
+{
+    STATUS_OPTIMAL,
+    STATUS_UNBOUNDED,
+    STATUS_INFEASIBLE,
+    STATUS_ERROR
+};
+
+struct Problem
+{
+    size_t index;
+    Matrix tableau;
+    Clock::time_point start;
+
+    Problem() : index(0), tableau(0, 0) {}
+    Problem(size_t i, Matrix t) :
+        index(i), tableau(std::move(t)), start(Clock::now())
+    {}
+};
+
+struct Solution
+{
+    size_t index;
+    Status status;
+    double objective;
+    std::vector<std::pair<size_t, double>> basis;
+    Clock::time_point start;
+};
+
+void ParseStage(std::istream& in, bool binary,
+                BlockingQueue<Problem>& problems)
+{
+    size_t index = 0;
+    while ((binary || in >> std::ws),
+           in.peek() != std::char_traits<char>::eof()) {
+        // the position in the stream is lost after an error, so the problems
+        // read so far are still solved, but the stream is not read any further
+        try {
+            Matrix m = binary ? Matrix::fromBinary(in)
+                              : Matrix::fromInput(in);
+            if (in.fail()) {
+                std::cerr << "Malformed tableau after problem " << index
+                          << ", stopping." << std::endl;
+                break;
+            }
+            problems.push(Problem(++index, std::move(m)));
+        } catch (const std::exception& e) {
+            std::cerr << "Cannot read tableau after problem " << index << ": "
+                      << e.what() << ", stopping." << std::endl;
+            break;
+        }
+    }
+    problems.close();
+}
+
+void SolveStage(BlockingQueue<Problem>& problems,
+                BlockingQueue<Solution>& solutions)
+{
+    Problem p;
+    while (problems.pop(p)) {
+        Matrix& t = p.tableau;
+        Solution s;
+        s.index = p.index;
+        s.start = p.start;
+        s.objective = 0.0;
+        double res;
+        bool feasible;
+        try {
+            feasible = Solve(t, res);
+        } catch (const std::exception& e) {
+            std::cerr << "Cannot solve problem " << p.index << ": "
+                      << e.what() << std::endl;
+            s.status = STATUS_ERROR;
+            solutions.push(std::move(s));
+            continue;
+        }
+        if (! feasible) {
+            s.status = STATUS_INFEASIBLE;
+        } else if (res == -std::numeric_limits<double>::infinity()) {
+            s.status = STATUS_UNBOUNDED;
+        } else {
+            s.status = STATUS_OPTIMAL;
+            s.objective = res;
+            for (size_t x = 1; x < t.M; ++x) {
+                s.basis.emplace_back(t.getMapping(x), t.get(x, 0));
+            }
+        }
+        solutions.push(std::move(s));
+    }
+    solutions.close();
+}
+
+void EmitStage(std::ostream& out, BlockingQueue<Solution>& solutions,
+               std::vector<double>& latencies)
+{
+    // enough digits to read back the exact values
+    std::streamsize precision = out.precision(17);
+    Solution s;
+    while (solutions.pop(s)) {
+        out << s.index;
+        switch (s.status) {
+        case STATUS_OPTIMAL:
+            out << " optimal " << s.objective;
+            for (const auto& b : s.basis) {
+                out << " x" << b.first << '=' << b.second;
+            }
+            break;
+        case STATUS_UNBOUNDED:
+            out << " unbounded";
+            break;
+        case STATUS_INFEASIBLE:
+            out << " infeasible";
+            break;
+        case STATUS_ERROR:
+            out << " error";
+            break;
+        }
+        out << '\n';
+        std::chrono::duration<double, std::micro> d = Clock::now() - s.start;
+        latencies.push_back(d.count());
+    }
+    out.precision(precision);
+    out.flush();
+}
+
+double Percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t rank = (size_t)(p / 100.0 * (double)(sorted.size() - 1) + 0.5);
+    return sorted[rank];
+}
+
+} // namespace
+
+size_t SolveBatchFromStream(std::istream& in, std::ostream& out, bool binary)
+{
+    BlockingQueue<Problem> problems(QUEUE_CAPACITY);
+    BlockingQueue<Solution> solutions(QUEUE_CAPACITY);
+    std::vector<double> latencies;
+
+    Clock::time_point begin = Clock::now();
+    std::thread parser(ParseStage, std::ref(in), binary, std::ref(problems));
+    std::thread solver(SolveStage, std::ref(problems), std::ref(solutions));
+    EmitStage(out, solutions, latencies);
+    parser.join();
+    solver.join();
+    std::chrono::duration<double> total = Clock::now() - begin;
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cerr << "problems:    " << latencies.size() << '\n'
+              << "time:        " << total.count() << " s\n"
+              << "latency p50: " << Percentile(latencies, 50) << " us\n"
+              << "latency p90: " << Percentile(latencies, 90) << " us\n"
+              << "latency p99: " << Percentile(latencies, 99) << " us\n"
+              << "latency max: "
+              << (latencies.empty() ? 0.0 : latencies.back()) << " us"
+              << std::endl;
+    return latencies.size();
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <iostream>
+
+/**
+ * Read a stream of concatenated tableaux (as text or in binary) and solve them
+ * one after another. Parsing, solving and output run on separate threads.
+ *
+ * For every problem a single result line is written to `out`:
+ *   <index> optimal <objective> x<var>=<value> ...
+ *   <index> unbounded
+ *   <index> infeasible
+ *   <index> error
+ * Values are written with 17 significant digits, so that they read back as the
+ * same doubles. The number of problems and latency percentiles are reported on stderr.
+ * A malformed tableau stops reading the stream; the problems read before it
+ * are still solved and their results written.
+ *
+ * Returns the number of problems solved.
+ */
+size_t SolveBatchFromStream(std::istream& in, std::ostream& out,
+                            bool binary = false);
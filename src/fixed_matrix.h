@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+
+#include "matrix.h"
+#include "row_reduction.h"
+#include "util.h"
+
+/**
+ * Vector of at most K entries with the interface of std::vector<double> that
+ * the simplex phases need.
+ */
+template <size_t K>
+struct FixedVector
+{
+private:
+    double Contents_[K];
+
+public:
+    FixedVector(size_t n, double x)
+    {
+        assert(n <= K && "vector exceeds fixed capacity!");
+        for (size_t i = 0; i < K; ++i) {
+            Contents_[i] = x;
+        }
+    }
+
+    double& operator[] (size_t i) { return Contents_[i]; }
+    double operator[] (size_t i) const { return Contents_[i]; }
+};
+
+/**
+ * Matrix with at most MM rows and NN columns whose storage lives on the stack.
+ * It has the same interface as Matrix, the actual size is given at runtime.
+ *
+ * Entries outside of the actual size are kept at 0.0, so that row operations
+ * can run over all NN columns with a loop bound known at compile time.
+ */
+template <size_t MM, size_t NN>
+struct FixedMatrix
+{
+    // Tableau of the artificial problem in phase 1.
+    typedef FixedMatrix<MM, NN + MM - 1> Artificial;
+    // Matrix for inverting the basis matrix in phase 1.
+    typedef FixedMatrix<MM - 1, 2 * (MM - 1)> Inverse;
+    typedef FixedVector<(MM > NN) ? MM : NN> Vector;
+
+private:
+    double Contents_[MM*NN];
+    size_t Mapping_[MM];
+
+public:
+    size_t M; // number of rows
+    size_t N; // number of columns
+
+public:
+    FixedMatrix(size_t m, size_t n) : M(m), N(n)
+    {
+        assert(m <= MM && n <= NN && "matrix exceeds fixed capacity!");
+        for (size_t i = 0; i < MM*NN; ++i) {
+            Contents_[i] = 0.0;
+        }
+        for (size_t i = 0; i < MM; ++i) {
+            Mapping_[i] = 0;
+        }
+    }
+
+    double get(size_t i, size_t j) const
+    {
+        return Contents_[i*NN + j];
+    }
+
+    void set(size_t i, size_t j, double x)
+    {
+        Contents_[i*NN + j] = x;
+    }
+
+    void multiplyRowBy(size_t a, double d)
+    {
+        double *p = Contents_ + a*NN;
+        for (size_t y = 0; y < NN; ++y) {
+            p[y] *= d;
+        }
+    }
+
+    void addDTimesRowBToRowA(size_t a, size_t b, double d)
+    {
+        double *p = Contents_ + a*NN;
+        const double *q = Contents_ + b*NN;
+        for (size_t y = 0; y < NN; ++y) {
+            p[y] += d*q[y];
+        }
+    }
+
+    void eliminate(size_t l, size_t j)
+    {
+        Eliminate(*this, l, j);
+    }
+
+    void removeRow(size_t row)
+    {
+        for (size_t v = row * NN; v < NN*(M-1); ++v) {
+            Contents_[v] = Contents_[v+NN];
+        }
+        for (size_t v = NN*(M-1); v < NN*M; ++v) {
+            Contents_[v] = 0.0;
+        }
+        for (size_t i = row; i < (M-1); ++i) {
+            Mapping_[i] = Mapping_[i+1];
+        }
+        M = M-1;
+    }
+
+    void reducedRowEchelon(bool fail_on_rank = true)
+    {
+        ReducedRowEchelon(*this, fail_on_rank);
+    }
+
+    void reduceToRank(void)
+    {
+        ReduceToRank(*this);
+    }
+
+    void canonicalize(void)
+    {
+        for (size_t i = 0; i < MM*NN; ++i) {
+            if (EQ(0, Contents_[i])) {
+                Contents_[i] = 0.0;
+            }
+        }
+    }
+
+    void setMapping(size_t row, size_t var)
+    {
+        Mapping_[row] = var;
+    }
+
+    size_t getMapping(size_t row) const
+    {
+        return Mapping_[row];
+    }
+
+    friend std::ostream& operator<< (std::ostream& stream, const FixedMatrix& m)
+    {
+        return stream << m.toMatrix();
+    }
+
+    void printMapping(std::ostream& stream) const
+    {
+        this->toMatrix().printMapping(stream);
+    }
+
+    /**
+     * Factory method for copying a matrix into fixed storage.
+     */
+    static FixedMatrix fromMatrix(const Matrix& other)
+    {
+        FixedMatrix res(other.M, other.N);
+        for (size_t x = 0; x < res.M; ++x) {
+            for (size_t y = 0; y < res.N; ++y) {
+                res.set(x, y, other.get(x, y));
+            }
+            res.setMapping(x, other.getMapping(x));
+        }
+        return res;
+    }
+
+    /**
+     * Copy entries and mapping into a dynamically sized matrix.
+     */
+    Matrix toMatrix(void) const
+    {
+        Matrix res(M, N);
+        for (size_t x = 0; x < M; ++x) {
+            for (size_t y = 0; y < N; ++y) {
+                res.set(x, y, this->get(x, y));
+            }
+            res.setMapping(x, this->getMapping(x));
+        }
+        return res;
+    }
+};
@@ -0,0 +1,268 @@
+#include "generator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+static const char *FamilyNames[] = {
+    "dense",
+    "sparse",
+    "transportation",
+    "assignment",
+    "klee-minty",
+    "degenerate"
+};
+
+Generator::Generator(const GeneratorConfig& config, size_t index) :
+    Config_(config), NextRow_(0), M(0), N(0)
+{
+    assert(config.size >= 1 && config.range >= 1 && "invalid generator config!");
+    uint64_t seed = (uint64_t)config.seed;
+    std::seed_seq seq{ (uint32_t)seed, (uint32_t)(seed >> 32),
+                       (uint32_t)config.family, (uint32_t)config.size,
+                       (uint32_t)index };
+    Rng_.seed(seq);
+
+    size_t k = Config_.size;
+    switch (Config_.family) {
+    case DENSE:
+    case KLEE_MINTY:
+        M = k+1;
+        N = 2*k+1;
+        break;
+    case SPARSE:
+    case DEGENERATE: {
+        M = k+1;
+        N = 2*k+1;
+        // b is chosen as A*x0 for a point x0 >= 0, so that the instances are
+        // feasible. For DEGENERATE, x0 has only few nonzero entries, so that
+        // many basic variables of the optimal solutions are 0.
+        Aux_.assign(N, 0.0);
+        std::uniform_int_distribution<long> val(1, Config_.range);
+        if (Config_.family == SPARSE) {
+            for (size_t y = 1; y < N; ++y) {
+                Aux_[y] = val(Rng_);
+            }
+        } else {
+            std::uniform_int_distribution<size_t> col(1, N-1);
+            for (size_t v = 0; v < std::max<size_t>(1, k/4); ++v) {
+                Aux_[col(Rng_)] = val(Rng_);
+            }
+        }
+        break;
+    }
+    case TRANSPORTATION:
+    case ASSIGNMENT: {
+        M = 2*k+1;
+        N = k*k+1;
+        // supplies followed by demands, with equal totals
+        Aux_.assign(2*k, 1.0);
+        if (Config_.family == TRANSPORTATION) {
+            std::uniform_int_distribution<long> val(1, Config_.range);
+            for (size_t i = 0; i < k; ++i) {
+                Aux_[i] = Aux_[k+i] = val(Rng_);
+            }
+            std::shuffle(Aux_.begin() + k, Aux_.end(), Rng_);
+        }
+        break;
+    }
+    }
+}
+
+bool Generator::nextRow(std::vector<double>& row)
+{
+    if (NextRow_ == M)
+        return false;
+    size_t x = NextRow_++;
+    size_t k = Config_.size;
+    long range = Config_.range;
+    std::uniform_int_distribution<long> entry(-range, range);
+    std::uniform_int_distribution<long> cost(0, range);
+    row.assign(N, 0.0);
+
+    switch (Config_.family) {
+    case DENSE:
+        for (size_t y = (x == 0) ? 1 : 0; y < N; ++y) {
+            row[y] = entry(Rng_);
+        }
+        break;
+    case SPARSE:
+        if (x == 0) {
+            for (size_t y = 1; y < N; ++y) {
+                row[y] = cost(Rng_);
+            }
+        } else {
+            std::uniform_int_distribution<long> val(1, range);
+            std::bernoulli_distribution negative(0.5);
+            size_t nonzeros = 0;
+            if (Config_.density > 0.0) {
+                // skip over the zero entries instead of drawing each of them
+                std::geometric_distribution<size_t> gap(
+                    std::min(Config_.density, 1.0));
+                for (size_t y = 1 + gap(Rng_); y < N; y += 1 + gap(Rng_)) {
+                    row[y] = negative(Rng_) ? -val(Rng_) : val(Rng_);
+                    row[0] += row[y] * Aux_[y];
+                    nonzeros++;
+                }
+            }
+            if (nonzeros == 0) {
+                // every constraint needs a nonzero entry, an empty row would
+                // not have full rank
+                size_t y = std::uniform_int_distribution<size_t>(1, N-1)(Rng_);
+                row[y] = negative(Rng_) ? -val(Rng_) : val(Rng_);
+                row[0] += row[y] * Aux_[y];
+            }
+        }
+        break;
+    case DEGENERATE:
+        if (x == 0) {
+            for (size_t y = 1; y < N; ++y) {
+                row[y] = cost(Rng_);
+            }
+        } else {
+            for (size_t y = 1; y < N; ++y) {
+                row[y] = entry(Rng_);
+                row[0] += row[y] * Aux_[y];
+            }
+        }
+        break;
+    case TRANSPORTATION:
+    case ASSIGNMENT:
+        if (x == 0) {
+            std::uniform_int_distribution<long> positive(1, range);
+            for (size_t y = 1; y < N; ++y) {
+                row[y] = positive(Rng_);
+            }
+        } else if (x <= k) {
+            // supply of source i: sum_j x_ij = s_i
+            size_t i = x-1;
+            row[0] = Aux_[i];
+            for (size_t j = 0; j < k; ++j) {
+                row[1 + i*k + j] = 1.0;
+            }
+        } else {
+            // demand of sink j: sum_i x_ij = d_j
+            size_t j = x-k-1;
+            row[0] = Aux_[k+j];
+            for (size_t i = 0; i < k; ++i) {
+                row[1 + i*k + j] = 1.0;
+            }
+        }
+        break;
+    case KLEE_MINTY:
+        if (x == 0) {
+            // maximize sum_j 2^(k-j) x_j
+            for (size_t j = 1; j <= k; ++j) {
+                row[j] = -std::ldexp(1.0, k-j);
+            }
+        } else {
+            // sum_{j<x} 2^(x-j+1) x_j + x_x + s_x = 5^x
+            row[0] = std::pow(5.0, x);
+            for (size_t j = 1; j < x; ++j) {
+                row[j] = std::ldexp(1.0, x-j+1);
+            }
+            row[x] = 1.0;
+            row[k+x] = 1.0;
+        }
+        break;
+    }
+    return true;
+}
+
+void Generator::write(std::ostream& stream, bool binary)
+{
+    std::vector<double> row;
+    if (binary) {
+        uint64_t size[2] = { M, N };
+        stream.write((const char *)size, sizeof(size));
+        while (this->nextRow(row)) {
+            stream.write((const char *)row.data(), N * sizeof(double));
+        }
+        return;
+    }
+
+    std::streamsize precision = stream.precision(17);
+    stream << M << " " << N << '\n';
+    while (this->nextRow(row)) {
+        for (size_t y = 0; y < N; ++y) {
+            stream << row[y];
+            if (y != N - 1)
+                stream << ' ';
+        }
+        stream << '\n';
+    }
+    stream.precision(precision);
+}
+
+Matrix Generator::toMatrix(void)
+{
+    Matrix res(M, N);
+    std::vector<double> row;
+    for (size_t x = 0; this->nextRow(row); ++x) {
+        for (size_t y = 0; y < N; ++y) {
+            res.set(x, y, row[y]);
+        }
+    }
+    return res;
+}
+
+size_t Generator::solverMemory(void) const
+{
+    // tableau, its copies in Phase1 and reduceToRank, artificial tableau and
+    // inversion matrix
+    return sizeof(double) * (3*M*N + M*(N+M-1) + 2*(M-1)*(M-1));
+}
+
+size_t Generator::maxSize(Family family)
+{
+    switch (family) {
+    case KLEE_MINTY:
+        // the right hand sides 5^k are exact up to 5^22 < 2^53
+        return 22;
+    default:
+        return SIZE_MAX;
+    }
+}
+
+bool Generator::parseFamily(const char* name, Family& family)
+{
+    for (size_t f = 0; f < sizeof(FamilyNames) / sizeof(*FamilyNames); ++f) {
+        if (strcmp(name, FamilyNames[f]) == 0) {
+            family = (Family)f;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Generator::familyName(Family family)
+{
+    return FamilyNames[family];
+}
+
+void GenerateInstances(GeneratorConfig config, size_t count, bool sweep,
+                       size_t mem_limit, bool binary, std::ostream& out)
+{
+    if (count == 0)
+        return;
+    for (;;) {
+        if (sweep && config.size > Generator::maxSize(config.family))
+            break;
+        Generator first(config);
+        if (sweep && first.solverMemory() > mem_limit)
+            break;
+        std::cerr << Generator::familyName(config.family) << " k = "
+                  << config.size << ": " << count << " x (" << first.M
+                  << " x " << first.N << ")" << std::endl;
+        first.write(out, binary);
+        for (size_t v = 1; v < count; ++v) {
+            Generator(config, v).write(out, binary);
+        }
+        if (! sweep)
+            break;
+        config.size *= 2;
+    }
+    out.flush();
+}
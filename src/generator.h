@@ -0,0 +1,114 @@
+#pragma once
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "matrix.h"
+
+/**
+ * Families of generated LP instances. For a size parameter k they have
+ *  DENSE, SPARSE, DEGENERATE:     k constraints, 2k variables
+ *  TRANSPORTATION, ASSIGNMENT:    k sources, k sinks, k*k variables
+ *  KLEE_MINTY:                    k constraints, k variables + k slacks
+ */
+enum Family
+{
+    DENSE,
+    SPARSE,
+    TRANSPORTATION,
+    ASSIGNMENT,
+    KLEE_MINTY,
+    DEGENERATE
+};
+
+/**
+ * Parameters for generating instances of a family.
+ */
+struct GeneratorConfig
+{
+    Family family;
+    size_t size;    // size parameter k >= 1, see Family
+    long range;     // random entries are drawn from [-range, +range], >= 1
+    double density; // fraction of nonzero constraint entries for SPARSE
+    long seed;
+};
+
+/**
+ * Generator for a single LP instance in the tableau format of
+ * Matrix::fromInput. The tableau is produced row by row, so that instances
+ * larger than the available memory can be streamed to a file.
+ *
+ * Every generator owns its RNG, seeded from the configuration and the index of
+ * the instance. Generators can thus be used from several threads at once and
+ * always produce the same instance for the same seed and index.
+ */
+struct Generator
+{
+private:
+    GeneratorConfig Config_;
+    std::mt19937_64 Rng_;
+    size_t NextRow_;
+    // DEGENERATE: feasible point, TRANSPORTATION/ASSIGNMENT: supplies/demands
+    std::vector<double> Aux_;
+
+public:
+    size_t M; // number of rows
+    size_t N; // number of columns
+
+public:
+    Generator(const GeneratorConfig& config, size_t index = 0);
+
+    /**
+     * Generate the next row of the tableau into row (resized to N entries).
+     *
+     * Returns false if all M rows have been generated.
+     */
+    bool nextRow(std::vector<double>& row);
+
+    /**
+     * Write the remaining rows of the tableau to stream, either as text (see
+     * Matrix::fromInput) or in binary (see Matrix::fromBinary).
+     */
+    void write(std::ostream& stream, bool binary);
+
+    /**
+     * Collect the remaining rows of the tableau in a matrix.
+     */
+    Matrix toMatrix(void);
+
+    /**
+     * Estimate the memory in bytes that Phase1 and Phase2 need for the
+     * instance.
+     */
+    size_t solverMemory(void) const;
+
+    /**
+     * Get the largest size parameter k for which a family can be generated.
+     * KLEE_MINTY is limited to the k for which all entries of the tableau are
+     * exact doubles.
+     */
+    static size_t maxSize(Family family);
+
+    /**
+     * Look up a family by name (e.g. "klee-minty").
+     *
+     * Returns false if there is no such family.
+     */
+    static bool parseFamily(const char* name, Family& family);
+
+    /**
+     * Get the name of a family.
+     */
+    static const char* familyName(Family family);
+};
+
+/**
+ * Write `count` generated instances to `out`, as text or in binary.
+ * If `sweep` is set, this is repeated for doubling sizes starting at
+ * config.size as long as the solver memory of an instance stays below
+ * mem_limit bytes and the size stays below Generator::maxSize. The sizes are
+ * reported on stderr.
+ */
+void GenerateInstances(GeneratorConfig config, size_t count, bool sweep,
+                       size_t mem_limit, bool binary, std::ostream& out);
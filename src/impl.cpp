@@ -1,14 +1,23 @@
 #include "impl.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <limits>
 #include <cassert>
 
+#include "fixed_matrix.h"
+#include "ipm.h"
+#include "lanes.h"
 #include "matrix.h"
+#include "pivot_rule.h"
+#include "trace.h"
 #include "util.h"
 
 static size_t pivot_counter = 0;
 
-Result PerformPivot(Matrix& t)
+template <typename T>
+Result PerformPivot(T& t)
 {
     ++pivot_counter;
     // choose first j with reduced cost < 0
@@ -31,31 +40,9 @@ Result PerformPivot(Matrix& t)
         std::cerr << " > Choose j = " << j << std::endl;
     }
 
-    // choose l that minimizes x_B(l) / u_l with u_l > 0
-    size_t l = 0;
-    std::vector<double> min(t.N, std::numeric_limits<double>::infinity());
-
-    // implement lexicographic pivoting rule
-    for (size_t x = 1; x < t.M; ++x) {
-        double ui = t.get(x, j);
-        if (LESS(0, ui)) {
-            for (size_t y = 0; y < t.N; ++y) {
-                double val = t.get(x, y) / ui;
-                if (LESS(val, min[y])) {
-                    // x is lexico-smaller
-                    for (size_t z = 0; z < t.N; ++z) {
-                        min[z] = t.get(x, z) / ui;
-                    }
-                    l = x;
-                    goto outer;
-                } else if (LESS(min[y], val)) {
-                    // x is lexico-larger
-                    goto outer;
-                }
-            }
-        }
-outer:;
-    }
+    // choose l that minimizes x_B(l) / u_l with u_l > 0, lexicographic
+    // pivoting rule for ties
+    size_t l = ChooseRowLexicographic(t, j);
 
     if (l == 0) {
         // if no such l exists => problem is unbounded
@@ -69,18 +56,20 @@ outer:;
     }
 
     t.eliminate(l, j);
+    TracePivot(j, l, -t.get(0, 0));
 
     if (verbose)
         std::cerr << " > non-optimal" << std::endl;
     return NONOPTIMAL;
 }
 
-bool Phase1(Matrix& t)
+template <typename T>
+typename T::Artificial Phase1Setup(T& t)
 {
     t.canonicalize();
     t.reduceToRank();
     // create tableau for artificial problem
-    Matrix a(t.M, t.N + t.M-1);
+    typename T::Artificial a(t.M, t.N + t.M-1);
 
     for (size_t x = 1; x < t.M; ++x) {
         // factor for making every entry of b >= 0
@@ -111,8 +100,12 @@ bool Phase1(Matrix& t)
         std::cerr << a << std::endl;
     }
 
-    // solve artificial LP
-    double res = Phase2(a);
+    return a;
+}
+
+template <typename T>
+bool Phase1Finish(T& t, typename T::Artificial& a, double res)
+{
     if (! EQ(res, 0))
         return false;
 
@@ -162,7 +155,7 @@ bool Phase1(Matrix& t)
     size_t rows = a.M-1;
     // note that inv is indexed starting from 0 (in contrast to the other
     // matrices)
-    Matrix inv(rows, 2*rows);
+    typename T::Inverse inv(rows, 2*rows);
     for (size_t x = 0; x < rows; ++x) {
         size_t var = a.getMapping(x+1);
         for (size_t y = 0; y < rows; ++y) {
@@ -187,7 +180,7 @@ bool Phase1(Matrix& t)
     inv.canonicalize();
     t.canonicalize();
 
-    Matrix t_old = t;
+    T t_old = t;
     t.set(0, 0, 0.0);
 
     // calculate rows 1..M for phase 2 (AB^-1 * b|A)
@@ -208,16 +201,16 @@ bool Phase1(Matrix& t)
     }
 
     // compute cB
-    std::vector<double> cb(t.M-1, 0.0);
+    typename T::Vector cb(t.M-1, 0.0);
     for (size_t x = 1; x < t.M; ++x) {
-        cb.at(x-1) = t_old.get(0, a.getMapping(x));
+        cb[x-1] = t_old.get(0, a.getMapping(x));
     }
 
     // calculate zeroth row
     for (size_t y = 0; y < t.N; ++y) {
         double val = 0.0;
         for (size_t x = 1; x < t.M; ++x) {
-            val += cb.at(x-1) * t.get(x, y);
+            val += cb[x-1] * t.get(x, y);
         }
         t.set(0, y, t.get(0, y) - val);
     }
@@ -232,8 +225,18 @@ bool Phase1(Matrix& t)
     return true;
 }
 
-double Phase2(Matrix& t)
+template <typename T>
+bool Phase1(T& t)
+{
+    typename T::Artificial a = Phase1Setup(t);
+    // solve artificial LP
+    return Phase1Finish(t, a, Phase2(a));
+}
+
+template <typename T>
+double Phase2(T& t)
 {
+    TraceRun();
     t.canonicalize();
     if (verbose) {
         std::cerr << "Phase 2: {{{" << std::endl;
@@ -265,22 +268,105 @@ double Phase2(Matrix& t)
     return - t.get(0, 0);
 }
 
-void SolveFromStream(std::istream& stream)
+template Result PerformPivot<Matrix>(Matrix& t);
+template Matrix Phase1Setup<Matrix>(Matrix& t);
+template bool Phase1Finish<Matrix>(Matrix& t, Matrix& a, double res);
+template bool Phase1<Matrix>(Matrix& t);
+template double Phase2<Matrix>(Matrix& t);
+
+// used by SolveLanes for the steps of phase 1 between the lockstep pivots
+#define INSTANTIATE_PHASE1_STEPS(MM, NN) \
+    template FixedMatrix<MM, NN>::Artificial \
+    Phase1Setup<FixedMatrix<MM, NN> >(FixedMatrix<MM, NN>& t); \
+    template bool Phase1Finish<FixedMatrix<MM, NN> >( \
+        FixedMatrix<MM, NN>& t, FixedMatrix<MM, NN>::Artificial& a, \
+        double res);
+INSTANTIATE_PHASE1_STEPS(4, 8)
+INSTANTIATE_PHASE1_STEPS(8, 16)
+INSTANTIATE_PHASE1_STEPS(16, 32)
+
+template <size_t MM, size_t NN>
+static bool SolveFixed(Matrix& t, double& objective)
 {
-    Matrix m = Matrix::fromInput(stream);
+    FixedMatrix<MM, NN> f = FixedMatrix<MM, NN>::fromMatrix(t);
+    bool feasible = Phase1(f);
+    if (feasible)
+        objective = Phase2(f);
+    t = f.toMatrix();
+    return feasible;
+}
+
+bool Solve(Matrix& t, double& objective)
+{
+    // dispatch to the smallest fixed capacity that fits
+    if (t.M <= 4 && t.N <= 8)
+        return SolveFixed<4, 8>(t, objective);
+    if (t.M <= 8 && t.N <= 16)
+        return SolveFixed<8, 16>(t, objective);
+    if (t.M <= 16 && t.N <= 32)
+        return SolveFixed<16, 32>(t, objective);
+
+    if (! Phase1(t))
+        return false;
+    objective = Phase2(t);
+    return true;
+}
+
+void SolveFromStream(std::istream& stream, bool binary, bool use_ipm)
+{
+    Matrix m(0, 0);
+    try {
+        m = binary ? Matrix::fromBinary(stream) : Matrix::fromInput(stream);
+    } catch (const std::exception& e) {
+        // e.g. std::bad_alloc for a header too large for the memory
+        std::cerr << "Malformed tableau: " << e.what() << std::endl;
+        return;
+    }
+    if (stream.fail()) {
+        std::cerr << "Malformed tableau" << std::endl;
+        return;
+    }
     std::cout << "Input:" << std::endl << m << std::endl;
-    if (! Phase1(m)) {
+    double res;
+    bool crossover;
+    bool feasible = use_ipm ? SolveInteriorPoint(m, res, crossover)
+                            : Solve(m, res);
+    if (use_ipm && ! crossover)
+        std::cerr << "No crossover from the interior point method,"
+                  << " solved with the simplex method." << std::endl;
+    if (! feasible) {
         std::cout << "Infeasible" << std::endl;
     } else {
-        Phase2(m);
         std::cout << "Final tableau:" << std::endl << m << std::endl;
         m.printMapping(std::cout);
         std::cout << std::endl;
     }
 }
 
-void PerformExperiments(long seed, long test_factor, unsigned long num_runs)
+// Largest violation |(Ax - b)_i| of the constraints of the tableau `original`
+// by the basic solution of the solved tableau t.
+static double PrimalResidual(const Matrix& original, const Matrix& t)
 {
+    std::vector<double> solution(original.N, 0.0);
+    for (size_t x = 1; x < t.M; ++x) {
+        solution[t.getMapping(x)] = t.get(x, 0);
+    }
+    double residual = 0.0;
+    for (size_t x = 1; x < original.M; ++x) {
+        double val = -original.get(x, 0);
+        for (size_t y = 1; y < original.N; ++y) {
+            val += original.get(x, y) * solution[y];
+        }
+        residual = std::max(residual, std::fabs(val));
+    }
+    return residual;
+}
+
+void PerformExperiments(long seed, long test_factor, unsigned long num_runs,
+                        bool compare_ipm)
+{
+    typedef std::chrono::steady_clock Clock;
+
     std::cout << "Performing experiments with random seed " << seed
               << std::endl << std::endl;
     std::srand(seed);
@@ -301,6 +387,18 @@ void PerformExperiments(long seed, long test_factor, unsigned long num_runs)
                 size_t infeasible = 0;
                 size_t unbounded = 0;
                 size_t finite = 0;
+                std::chrono::duration<double> time_simplex(0);
+                // simplex and interior-point times of the problems with a
+                // crossover, and of the failed interior-point runs and their
+                // fallback to the simplex method
+                std::chrono::duration<double> time_simplex_crossover(0);
+                std::chrono::duration<double> time_ipm_crossover(0);
+                std::chrono::duration<double> time_ipm_failed(0);
+                std::chrono::duration<double> time_fallback(0);
+                size_t crossovers = 0;
+                size_t disagreements = 0;
+                double residual_simplex = 0.0;
+                double residual_ipm = 0.0;
                 std::cout << "Configuration " << ++counter;
                 std::cout << " ( n = " << i << ", ";
                 std::cout << " m = " << i+j << ", ";
@@ -308,10 +406,54 @@ void PerformExperiments(long seed, long test_factor, unsigned long num_runs)
                           << " runs:" << std::endl;
                 for (size_t v = 0; v < num_runs; ++v) {
                     Matrix m = Matrix::fromRandom(i, i+j, r);
-                    if (! Phase1(m)) {
+                    Matrix original = compare_ipm ? m : Matrix(0, 0);
+                    Matrix m_ipm = original;
+                    double res = 0.0;
+                    Clock::time_point begin = Clock::now();
+                    bool feasible = Phase1(m);
+                    if (feasible)
+                        res = Phase2(m);
+                    std::chrono::duration<double> simplex = Clock::now() - begin;
+                    time_simplex += simplex;
+                    if (compare_ipm) {
+                        // the pivots of the crossover and the fallback are not
+                        // counted
+                        size_t pivots = pivot_counter;
+                        double res_ipm = 0.0;
+                        bool feasible_ipm = true;
+                        begin = Clock::now();
+                        bool crossover = CrossoverFromInteriorPoint(m_ipm,
+                                                                    res_ipm);
+                        std::chrono::duration<double> ipm = Clock::now() - begin;
+                        if (crossover) {
+                            crossovers++;
+                            time_simplex_crossover += simplex;
+                            time_ipm_crossover += ipm;
+                        } else {
+                            // fall back like SolveInteriorPoint
+                            time_ipm_failed += ipm;
+                            m_ipm = original;
+                            begin = Clock::now();
+                            feasible_ipm = Phase1(m_ipm);
+                            if (feasible_ipm)
+                                res_ipm = Phase2(m_ipm);
+                            time_fallback += Clock::now() - begin;
+                        }
+                        pivot_counter = pivots;
+                        double diff = std::fabs(res - res_ipm);
+                        if (feasible != feasible_ipm || (feasible &&
+                                res != res_ipm && diff > 1e-6 * (1 + std::fabs(res))))
+                            disagreements++;
+                        if (feasible && std::isfinite(res))
+                            residual_simplex = std::max(residual_simplex,
+                                    PrimalResidual(original, m));
+                        if (feasible_ipm && std::isfinite(res_ipm))
+                            residual_ipm = std::max(residual_ipm,
+                                    PrimalResidual(original, m_ipm));
+                    }
+                    if (! feasible) {
                         infeasible ++;
                     } else {
-                        double res = Phase2(m);
                         if (res == -std::numeric_limits<double>::infinity()) {
                             unbounded++;
                         } else {
@@ -327,8 +469,118 @@ void PerformExperiments(long seed, long test_factor, unsigned long num_runs)
                 std::cout << "  unbounded:   " << res_unbounded << "\%" << std::endl;
                 std::cout << "  infeasible:  " << res_infeasible << "\%" << std::endl;
                 std::cout << "  pivots(avg): " << res_pivots << std::endl;
+                if (compare_ipm) {
+                    double res_crossover = 100.0*((double)crossovers / (double)num_runs);
+                    std::cout << "  simplex time:   " << time_simplex.count() << " s" << std::endl;
+                    std::cout << "  ipm crossover:  " << res_crossover << "\%" << std::endl;
+                    std::cout << "  with crossover: simplex " << time_simplex_crossover.count()
+                              << " s, ipm " << time_ipm_crossover.count() << " s" << std::endl;
+                    std::cout << "  no crossover:   ipm " << time_ipm_failed.count()
+                              << " s, fallback " << time_fallback.count() << " s" << std::endl;
+                    std::cout << "  disagreements:  " << disagreements << std::endl;
+                    std::cout << "  max |Ax-b|:     simplex " << residual_simplex
+                              << ", ipm " << residual_ipm << std::endl;
+                }
                 std::cout << std::endl;
             }
         }
     }
 }
+
+// Solve all tableaux with the given engine: 0 runs Phase1 and Phase2 on each
+// Matrix, 1 uses Solve, any other value is the number of lanes for SolveLanes.
+static void SolveAll(std::vector<Matrix>& tableaux, size_t engine,
+                     std::vector<bool>& feasible, std::vector<double>& objective)
+{
+    if (engine > 1) {
+        SolveLanes(tableaux, engine, feasible, objective);
+        return;
+    }
+    feasible.assign(tableaux.size(), false);
+    objective.assign(tableaux.size(), 0.0);
+    for (size_t v = 0; v < tableaux.size(); ++v) {
+        Matrix& m = tableaux[v];
+        double res = 0.0;
+        if (engine == 0) {
+            if (Phase1(m)) {
+                feasible[v] = true;
+                res = Phase2(m);
+            }
+        } else {
+            feasible[v] = Solve(m, res);
+        }
+        objective[v] = res;
+    }
+}
+
+void PerformBenchmark(long seed, unsigned long num_runs)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::cout << "Benchmarking with random seed " << seed << std::endl
+              << std::endl;
+    std::srand(seed);
+
+    // (rows, columns) of the generated tableaux
+    static size_t Sizes[][2] = { { 4, 6 }, { 4, 7 }, { 8, 16 }, { 16, 32 } };
+    static size_t Range = 4;
+    // engines as understood by SolveAll
+    static size_t Engines[] = { 0, 1, 4, 8, 16 };
+    // minimal time spent per engine and configuration
+    static double MinSeconds = 0.5;
+
+    for (auto& size : Sizes) {
+        std::vector<Matrix> inputs;
+        for (size_t v = 0; v < num_runs; ++v) {
+            inputs.push_back(Matrix::fromRandom(size[0], size[1], Range));
+        }
+
+        std::cout << "Configuration " << size[0] << "x" << size[1] << ", "
+                  << num_runs << " tableaux:" << std::endl;
+
+        std::vector<bool> ref_feasible;
+        std::vector<double> ref_objective;
+        double ref_rate = 0.0;
+        for (size_t engine : Engines) {
+            std::vector<Matrix> tableaux;
+            std::vector<bool> feasible;
+            std::vector<double> objective;
+            size_t solves = 0;
+            Clock::time_point begin = Clock::now();
+            std::chrono::duration<double> elapsed;
+            do {
+                tableaux = inputs;
+                SolveAll(tableaux, engine, feasible, objective);
+                solves += inputs.size();
+                elapsed = Clock::now() - begin;
+            } while (elapsed.count() < MinSeconds);
+            double rate = (double)solves / elapsed.count();
+
+            if (engine == 0) {
+                ref_feasible = feasible;
+                ref_objective = objective;
+                ref_rate = rate;
+            }
+            // check that every engine agrees with the generic one
+            size_t mismatches = 0;
+            for (size_t v = 0; v < inputs.size(); ++v) {
+                if (feasible[v] != ref_feasible[v] ||
+                        (objective[v] != ref_objective[v] &&
+                         ! EQ(objective[v], ref_objective[v])))
+                    mismatches++;
+            }
+
+            if (engine == 0) {
+                std::cout << "  generic:   ";
+            } else if (engine == 1) {
+                std::cout << "  fixed:     ";
+            } else {
+                std::cout << "  lanes x" << engine
+                          << (engine < 10 ? ":  " : ": ");
+            }
+            std::cout << rate << " LPs/s (speedup " << rate / ref_rate
+                      << ", " << mismatches << " mismatches)" << std::endl;
+        }
+        std::cout << std::endl;
+    }
+}
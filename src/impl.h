@@ -14,10 +14,12 @@ enum Result
 
 /**
  * Perform one iteration of the simplex method.
+ * The tableau type T is either Matrix or a FixedMatrix (see fixed_matrix.h).
  *
  * Returns the termination state of the simplex method.
  */
-Result PerformPivot(Matrix& t);
+template <typename T>
+Result PerformPivot(T& t);
 
 /**
  * Perform phase 1 of the full tableau simplex method.
@@ -26,22 +28,70 @@ Result PerformPivot(Matrix& t);
  *
  * Returns true if the problem is feasible and false otherwise.
  */
-bool Phase1(Matrix& t);
+template <typename T>
+bool Phase1(T& t);
+
+/**
+ * First half of Phase1: reduce t to full rank and create the tableau of the
+ * artificial problem.
+ *
+ * Returns the artificial tableau, which is to be solved with Phase2.
+ */
+template <typename T>
+typename T::Artificial Phase1Setup(T& t);
+
+/**
+ * Second half of Phase1: drive the artificial variables out of the basis of
+ * the solved artificial tableau a and create the tableau for phase 2.
+ * res is the optimal objective value of the artificial problem.
+ *
+ * Returns true if the problem is feasible and false otherwise.
+ */
+template <typename T>
+bool Phase1Finish(T& t, typename T::Artificial& a, double res);
 
 /**
  * Perform phase 2 of the full tableau simplex method.
  *
  * Returns the achieved optimal objective value (can be -infinity).
  */
-double Phase2(Matrix& t);
+template <typename T>
+double Phase2(T& t);
+
+/**
+ * Perform both phases of the full tableau simplex method.
+ * Tableaux with up to 16 rows and 32 columns are solved in a FixedMatrix of
+ * matching capacity, larger ones directly.
+ *
+ * Returns false if the problem is infeasible. Otherwise t contains the final
+ * tableau and objective the optimal objective value (can be -infinity).
+ */
+bool Solve(Matrix& t, double& objective);
 
 /**
- * Read a tableau from stream and solve it.
+ * Read a tableau from stream (as text or in binary) and solve it, with
+ * SolveInteriorPoint if use_ipm is set. A malformed tableau, also one too
+ * large for the memory, is reported on stderr.
  */
-void SolveFromStream(std::istream& stream);
+void SolveFromStream(std::istream& stream, bool binary = false,
+                     bool use_ipm = false);
 
 /**
  * Perform the experiments described in exercise (d).
  * The test_factor determines the input size for the experiments.
+ * The problems are solved with Phase1 and Phase2.
+ * If compare_ipm is set, every problem is also solved like SolveInteriorPoint
+ * does, with the number of problems on which both methods disagree and the
+ * largest violation |Ax-b| of the solutions of each method. The simplex time
+ * and the time of the interior-point method with crossover are reported for
+ * the problems with a crossover; the time of the other interior-point runs
+ * and of their fallback to the simplex method is reported separately.
+ */
+void PerformExperiments(long seed, long test_factor, unsigned long num_runs,
+                        bool compare_ipm = false);
+
+/**
+ * Compare the throughput of the size-specialized solver used by Solve for
+ * small tableaux and of SolveLanes against Phase1 and Phase2 on a Matrix.
  */
-void PerformExperiments(long seed, long test_factor, unsigned long num_runs);
+void PerformBenchmark(long seed, unsigned long num_runs);
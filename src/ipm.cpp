@@ -0,0 +1,404 @@
+#include "ipm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "impl.h"
+#include "util.h"
+
+// Relative tolerance for primal and dual residuals and the duality gap.
+#define IPM_TOLERANCE 1e-9
+#define IPM_MAX_ITERATIONS 100
+// Fraction of the maximal step towards the boundary that is taken.
+#define IPM_STEP 0.99
+// Iterates beyond this norm indicate an infeasible or unbounded problem.
+#define IPM_DIVERGENCE 1e12
+// The method is considered stalled if the primal and dual residuals did not
+// shrink by IPM_STALL_FACTOR or all steps were shorter than IPM_SHORT_STEP
+// during the last IPM_STALL_ITERATIONS iterations.
+#define IPM_STALL_ITERATIONS 5
+#define IPM_STALL_FACTOR 0.9
+#define IPM_SHORT_STEP 1e-2
+
+typedef std::vector<double> Vector;
+
+/**
+ * Constraint matrix (m x n, row-major), right hand side and cost of the LP
+ * min c^T x s.t. Ax = b, x >= 0.
+ */
+struct StandardForm
+{
+    size_t m;
+    size_t n;
+    Vector A;
+    Vector b;
+    Vector c;
+
+    explicit StandardForm(const Matrix& t) :
+        m(t.M-1), n(t.N-1), A(m*n), b(m), c(n)
+    {
+        for (size_t j = 0; j < n; ++j) {
+            c[j] = t.get(0, j+1);
+        }
+        for (size_t i = 0; i < m; ++i) {
+            b[i] = t.get(i+1, 0);
+            for (size_t j = 0; j < n; ++j) {
+                A[i*n + j] = t.get(i+1, j+1);
+            }
+        }
+    }
+
+    // y = A x
+    void multiply(const Vector& x, Vector& y) const
+    {
+        for (size_t i = 0; i < m; ++i) {
+            double val = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                val += A[i*n + j] * x[j];
+            }
+            y[i] = val;
+        }
+    }
+
+    // x = A^T y
+    void multiplyTransposed(const Vector& y, Vector& x) const
+    {
+        std::fill(x.begin(), x.end(), 0.0);
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                x[j] += A[i*n + j] * y[i];
+            }
+        }
+    }
+};
+
+static double Dot(const Vector& a, const Vector& b)
+{
+    double val = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        val += a[i] * b[i];
+    }
+    return val;
+}
+
+static double Norm(const Vector& a)
+{
+    return std::sqrt(Dot(a, a));
+}
+
+/**
+ * Compute the Cholesky factor L of A diag(d) A^T (m x m, lower triangle).
+ * Pivots that vanish (dependent rows) are replaced by a huge value, so that
+ * the corresponding components of solutions become 0.
+ */
+static void FactorNormalMatrix(const StandardForm& lp, const Vector& d,
+                               Vector& L)
+{
+    size_t m = lp.m;
+    size_t n = lp.n;
+    Vector row(n);
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            row[j] = lp.A[i*n + j] * d[j];
+        }
+        for (size_t k = 0; k <= i; ++k) {
+            double val = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                val += row[j] * lp.A[k*n + j];
+            }
+            L[i*m + k] = val;
+        }
+    }
+
+    for (size_t j = 0; j < m; ++j) {
+        double diag = L[j*m + j];
+        for (size_t k = 0; k < j; ++k) {
+            diag -= L[j*m + k] * L[j*m + k];
+        }
+        if (diag <= EPSILON * EPSILON * std::fabs(L[j*m + j]) || diag <= 0.0)
+            diag = 1e128;
+        diag = std::sqrt(diag);
+        L[j*m + j] = diag;
+        for (size_t i = j+1; i < m; ++i) {
+            double val = L[i*m + j];
+            for (size_t k = 0; k < j; ++k) {
+                val -= L[i*m + k] * L[j*m + k];
+            }
+            L[i*m + j] = val / diag;
+        }
+    }
+}
+
+/**
+ * Solve L L^T y = r in place.
+ */
+static void SolveFactored(const Vector& L, size_t m, Vector& r)
+{
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t k = 0; k < i; ++k) {
+            r[i] -= L[i*m + k] * r[k];
+        }
+        r[i] /= L[i*m + i];
+    }
+    for (size_t i = m; i-- > 0;) {
+        for (size_t k = i+1; k < m; ++k) {
+            r[i] -= L[k*m + i] * r[k];
+        }
+        r[i] /= L[i*m + i];
+    }
+}
+
+/**
+ * Solve the Newton system
+ *   A dx = -rb,  A^T dl + ds = -rc,  S dx + X ds = rxs
+ * with the factored normal matrix L of A (X/S) A^T.
+ */
+static void Direction(const StandardForm& lp, const Vector& L,
+                      const Vector& x, const Vector& s, const Vector& rb,
+                      const Vector& rc, const Vector& rxs,
+                      Vector& dx, Vector& dl, Vector& ds)
+{
+    Vector tmp(lp.n);
+    for (size_t j = 0; j < lp.n; ++j) {
+        tmp[j] = (rxs[j] + x[j] * rc[j]) / s[j];
+    }
+    lp.multiply(tmp, dl);
+    for (size_t i = 0; i < lp.m; ++i) {
+        dl[i] = -rb[i] - dl[i];
+    }
+    SolveFactored(L, lp.m, dl);
+
+    lp.multiplyTransposed(dl, ds);
+    for (size_t j = 0; j < lp.n; ++j) {
+        ds[j] = -rc[j] - ds[j];
+        dx[j] = (rxs[j] - x[j] * ds[j]) / s[j];
+    }
+}
+
+/**
+ * Returns the largest step alpha <= 1 with v + alpha dv >= 0.
+ */
+static double MaxStep(const Vector& v, const Vector& dv)
+{
+    double alpha = 1.0;
+    for (size_t j = 0; j < v.size(); ++j) {
+        if (dv[j] < 0.0)
+            alpha = std::min(alpha, -v[j] / dv[j]);
+    }
+    return alpha;
+}
+
+/**
+ * Run the predictor-corrector method on lp.
+ *
+ * Returns true if the iterates x, s converged to an optimal solution.
+ */
+static bool InteriorPoint(const StandardForm& lp, Vector& x, Vector& s)
+{
+    size_t m = lp.m;
+    size_t n = lp.n;
+    Vector L(m*m);
+    Vector l(m);
+    Vector tmp(m);
+
+    // Mehrotra's starting point: least squares solutions of Ax = b and
+    // A^T l + s = c, shifted into the positive orthant
+    FactorNormalMatrix(lp, Vector(n, 1.0), L);
+    tmp = lp.b;
+    SolveFactored(L, m, tmp);
+    lp.multiplyTransposed(tmp, x);
+    lp.multiply(lp.c, l);
+    SolveFactored(L, m, l);
+    lp.multiplyTransposed(l, s);
+    for (size_t j = 0; j < n; ++j) {
+        s[j] = lp.c[j] - s[j];
+    }
+    double dx = std::max(-1.5 * *std::min_element(x.begin(), x.end()), 0.0);
+    double ds = std::max(-1.5 * *std::min_element(s.begin(), s.end()), 0.0);
+    for (size_t j = 0; j < n; ++j) {
+        x[j] += dx;
+        s[j] += ds;
+    }
+    double xs = Dot(x, s);
+    double sum_x = 0.0;
+    double sum_s = 0.0;
+    for (size_t j = 0; j < n; ++j) {
+        sum_x += x[j];
+        sum_s += s[j];
+    }
+    dx = 0.5 * xs / sum_s;
+    ds = 0.5 * xs / sum_x;
+    for (size_t j = 0; j < n; ++j) {
+        x[j] += dx + EPSILON;
+        s[j] += ds + EPSILON;
+    }
+
+    double norm_b = Norm(lp.b);
+    double norm_c = Norm(lp.c);
+    Vector rb(m), rc(n), rxs(n), d(n);
+    Vector dx_aff(n), dl_aff(m), ds_aff(n);
+    Vector dx_cc(n), dl_cc(m), ds_cc(n);
+    double best_residual = std::numeric_limits<double>::infinity();
+    size_t last_progress = 0;
+    size_t short_steps = 0;
+
+    for (size_t iter = 0; iter < IPM_MAX_ITERATIONS; ++iter) {
+        // residuals
+        lp.multiply(x, rb);
+        for (size_t i = 0; i < m; ++i) {
+            rb[i] -= lp.b[i];
+        }
+        lp.multiplyTransposed(l, rc);
+        for (size_t j = 0; j < n; ++j) {
+            rc[j] += s[j] - lp.c[j];
+        }
+        double primal = Dot(lp.c, x);
+        double dual = Dot(lp.b, l);
+        double residual = std::max(Norm(rb) / (1.0 + norm_b),
+                                   Norm(rc) / (1.0 + norm_c));
+        if (residual < IPM_TOLERANCE &&
+                std::fabs(primal - dual) / (1.0 + std::fabs(primal))
+                    < IPM_TOLERANCE)
+            return true;
+        if (Norm(x) > IPM_DIVERGENCE || Norm(l) > IPM_DIVERGENCE)
+            return false;
+
+        // the residuals of infeasible and unbounded problems stop shrinking
+        // (while the duality gap may still change), give up long before the
+        // iteration limit
+        if (residual < IPM_TOLERANCE ||
+                residual < IPM_STALL_FACTOR * best_residual) {
+            best_residual = std::min(best_residual, residual);
+            last_progress = iter;
+        } else if (iter - last_progress >= IPM_STALL_ITERATIONS) {
+            return false;
+        }
+
+        double mu = Dot(x, s) / n;
+        for (size_t j = 0; j < n; ++j) {
+            d[j] = x[j] / s[j];
+        }
+        FactorNormalMatrix(lp, d, L);
+
+        // predictor (affine scaling direction)
+        for (size_t j = 0; j < n; ++j) {
+            rxs[j] = -x[j] * s[j];
+        }
+        Direction(lp, L, x, s, rb, rc, rxs, dx_aff, dl_aff, ds_aff);
+        double alpha_p = MaxStep(x, dx_aff);
+        double alpha_d = MaxStep(s, ds_aff);
+        double mu_aff = 0.0;
+        for (size_t j = 0; j < n; ++j) {
+            mu_aff += (x[j] + alpha_p * dx_aff[j]) * (s[j] + alpha_d * ds_aff[j]);
+        }
+        mu_aff /= n;
+        double sigma = std::pow(mu_aff / mu, 3);
+
+        // corrector with centering
+        for (size_t j = 0; j < n; ++j) {
+            rxs[j] = -x[j] * s[j] - dx_aff[j] * ds_aff[j] + sigma * mu;
+        }
+        Direction(lp, L, x, s, rb, rc, rxs, dx_cc, dl_cc, ds_cc);
+        alpha_p = std::min(1.0, IPM_STEP * MaxStep(x, dx_cc));
+        alpha_d = std::min(1.0, IPM_STEP * MaxStep(s, ds_cc));
+        if (alpha_p < EPSILON && alpha_d < EPSILON)
+            return false;
+        short_steps = (std::max(alpha_p, alpha_d) < IPM_SHORT_STEP)
+                      ? short_steps + 1 : 0;
+        if (short_steps >= IPM_STALL_ITERATIONS)
+            return false;
+
+        for (size_t j = 0; j < n; ++j) {
+            x[j] += alpha_p * dx_cc[j];
+            s[j] += alpha_d * ds_cc[j];
+        }
+        for (size_t i = 0; i < m; ++i) {
+            l[i] += alpha_d * dl_cc[i];
+        }
+    }
+    return false;
+}
+
+/**
+ * Pivot the columns with the largest x_j/s_j into the basis of t.
+ *
+ * Returns true if the resulting basis is primal feasible.
+ */
+static bool Crossover(Matrix& t, const Vector& x, const Vector& s)
+{
+    std::vector<size_t> order(x.size());
+    for (size_t j = 0; j < order.size(); ++j) {
+        order[j] = j;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return x[a] * s[b] > x[b] * s[a];
+    });
+
+    std::vector<bool> assigned(t.M, false);
+    size_t num_assigned = 0;
+    for (size_t j : order) {
+        if (num_assigned == t.M-1)
+            break;
+        // choose the largest pivot among the rows without basic variable
+        size_t l = 0;
+        double max = EPSILON;
+        for (size_t r = 1; r < t.M; ++r) {
+            double val = std::fabs(t.get(r, j+1));
+            if (! assigned[r] && val > max) {
+                max = val;
+                l = r;
+            }
+        }
+        if (l == 0)
+            continue;
+        t.eliminate(l, j+1);
+        assigned[l] = true;
+        num_assigned++;
+    }
+
+    // rows without basic variable are linear combinations of the others
+    for (size_t r = t.M-1; r > 0; --r) {
+        if (assigned[r])
+            continue;
+        if (! EQ(t.get(r, 0), 0))
+            return false;
+        t.removeRow(r);
+    }
+
+    t.canonicalize();
+    for (size_t r = 1; r < t.M; ++r) {
+        if (LESS(t.get(r, 0), 0))
+            return false;
+    }
+    return true;
+}
+
+bool CrossoverFromInteriorPoint(Matrix& t, double& objective)
+{
+    t.canonicalize();
+    t.reduceToRank();
+    t.set(0, 0, 0.0);
+    if (t.M <= 1 || t.N <= 1)
+        return false;
+    StandardForm lp(t);
+    Vector x(lp.n);
+    Vector s(lp.n);
+    if (! InteriorPoint(lp, x, s) || ! Crossover(t, x, s))
+        return false;
+    objective = Phase2(t);
+    return true;
+}
+
+bool SolveInteriorPoint(Matrix& t, double& objective, bool& crossover)
+{
+    Matrix original = t;
+    crossover = CrossoverFromInteriorPoint(t, objective);
+    if (crossover)
+        return true;
+
+    // fall back to the simplex method
+    t = original;
+    return Solve(t, objective);
+}
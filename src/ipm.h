@@ -0,0 +1,33 @@
+#pragma once
+
+#include "matrix.h"
+
+/**
+ * Solve the LP given by tableau t (same format as for Phase1) with Mehrotra's
+ * primal-dual predictor-corrector interior-point method. The Newton systems
+ * are solved via the normal equations A D A^T with a Cholesky factorization.
+ *
+ * The interior solution is crossed over to a basis: the columns with the
+ * largest x_j/s_j enter the basis of t one after another, and Phase2 finishes
+ * from there. Afterwards t is a full tableau with its mapping set, as after
+ * Phase1 and Phase2.
+ *
+ * If the method does not converge or stalls (residuals that stop shrinking or
+ * steps that stay short, typical for infeasible or unbounded problems), or the
+ * crossover basis is not primal feasible, the problem is solved with Solve
+ * instead and `crossover` is set to false.
+ *
+ * Returns false if the problem is infeasible. Otherwise objective is set to
+ * the optimal objective value (can be -infinity).
+ */
+bool SolveInteriorPoint(Matrix& t, double& objective, bool& crossover);
+
+/**
+ * The interior-point method and the crossover of SolveInteriorPoint, without
+ * the fallback to Solve.
+ *
+ * Returns true if the crossover succeeded; objective is then set to the
+ * optimal objective value. Otherwise t is left in an unspecified state and
+ * the problem still has to be solved from the original tableau.
+ */
+bool CrossoverFromInteriorPoint(Matrix& t, double& objective);
@@ -0,0 +1,512 @@
+#include "lanes.h"
+
+#include <cassert>
+#include <limits>
+
+#include "fixed_matrix.h"
+#include "impl.h"
+#include "pivot_rule.h"
+#include "util.h"
+
+// The lanes are processed in packs of doubles with GCC vector extensions, one
+// SSE2 register by default and one AVX register if the build enables AVX.
+#ifdef __AVX__
+#define PACK_BYTES 32
+#else
+#define PACK_BYTES 16
+#endif
+#define PACK_SIZE (PACK_BYTES / sizeof(double))
+
+typedef double Pack __attribute__((vector_size(PACK_BYTES)));
+
+static inline Pack Splat(double x)
+{
+    Pack v;
+    for (size_t i = 0; i < PACK_SIZE; ++i) {
+        v[i] = x;
+    }
+    return v;
+}
+
+static inline Pack Load(const double *p)
+{
+    return *(const Pack *)p;
+}
+
+static inline void Store(double *p, Pack v)
+{
+    *(Pack *)p = v;
+}
+
+/**
+ * W full tableaux with at most MM rows and NN columns. The tableaux are stored
+ * interleaved: entry (i, j) of lane k is at index (i*NN + j)*W + k, so that
+ * the same entry of all lanes is contiguous.
+ * Like FixedMatrix, the storage has a fixed capacity. Rows and columns beyond
+ * the actual size of a lane stay 0.0 and thus never take part in a pivot
+ * step, so all loops can run over the full capacity.
+ * The pricing, the ratio test and the row operations work on packs of
+ * PACK_SIZE lanes; W has to be a multiple of it.
+ */
+template <size_t W, size_t MM, size_t NN>
+struct LaneTableau
+{
+    static_assert(W % PACK_SIZE == 0, "W must be a multiple of PACK_SIZE!");
+    static const size_t P = W / PACK_SIZE; // packs per entry
+
+private:
+    alignas(PACK_BYTES) double Contents_[MM*NN*W];
+    size_t Mapping_[MM*W];
+    // scratch space for a pivot step, interleaved like Contents_
+    alignas(PACK_BYTES) double Column_[MM*W]; // entering columns
+    alignas(PACK_BYTES) double Ratio_[MM*W];
+    alignas(PACK_BYTES) double Factor_[MM*W];
+    alignas(PACK_BYTES) double Pivot_[NN*W];  // normalized pivot rows
+
+public:
+    LaneTableau()
+    {
+        for (size_t i = 0; i < MM*NN*W; ++i) {
+            Contents_[i] = 0.0;
+        }
+        for (size_t i = 0; i < MM*W; ++i) {
+            Mapping_[i] = 0;
+        }
+    }
+
+    double get(size_t k, size_t i, size_t j) const
+    {
+        return Contents_[(i*NN + j)*W + k];
+    }
+
+    void set(size_t k, size_t i, size_t j, double x)
+    {
+        Contents_[(i*NN + j)*W + k] = x;
+    }
+
+    /**
+     * Read-only view of lane k with the get/M/N interface of a tableau, for
+     * the pivot rules of pivot_rule.h.
+     */
+    struct LaneView
+    {
+        static const size_t M = MM;
+        static const size_t N = NN;
+        typedef typename FixedMatrix<MM, NN>::Vector Vector;
+
+        LaneView(const LaneTableau& t, size_t k) : t_(t), k_(k) {}
+
+        double get(size_t i, size_t j) const
+        {
+            return t_.get(k_, i, j);
+        }
+
+    private:
+        const LaneTableau& t_;
+        size_t k_;
+    };
+
+    /**
+     * Copy tableau t into lane k.
+     */
+    template <typename T>
+    void load(size_t k, const T& t)
+    {
+        assert(t.M <= MM && t.N <= NN && "tableau does not fit into lanes!");
+        for (size_t x = 0; x < t.M; ++x) {
+            for (size_t y = 0; y < t.N; ++y) {
+                this->set(k, x, y, t.get(x, y));
+            }
+            for (size_t y = t.N; y < NN; ++y) {
+                this->set(k, x, y, 0.0);
+            }
+            Mapping_[x*W + k] = t.getMapping(x);
+        }
+        for (size_t x = t.M; x < MM; ++x) {
+            for (size_t y = 0; y < NN; ++y) {
+                this->set(k, x, y, 0.0);
+            }
+            Mapping_[x*W + k] = 0;
+        }
+    }
+
+    /**
+     * Copy lane k back into tableau t.
+     */
+    template <typename T>
+    void store(size_t k, T& t) const
+    {
+        for (size_t x = 0; x < t.M; ++x) {
+            for (size_t y = 0; y < t.N; ++y) {
+                t.set(x, y, this->get(k, x, y));
+            }
+            t.setMapping(x, Mapping_[x*W + k]);
+        }
+    }
+
+    /**
+     * Choose the first column with reduced cost < 0 for every lane.
+     * j[k] is 0 if there is no such column.
+     */
+    void chooseColumns(size_t *j) const
+    {
+        // column indices are kept as double to select them with the mask of
+        // the compare
+        const Pack negative_epsilon = Splat(-EPSILON);
+        Pack col[P];
+        for (size_t g = 0; g < P; ++g) {
+            col[g] = Splat(0.0);
+        }
+        // backwards, so that the first such column is assigned last
+        double index = (double)(NN-1);
+        for (size_t y = NN-1; y > 0; --y, index -= 1.0) {
+            const Pack idx = Splat(index);
+            const double *p = &Contents_[y*W];
+            for (size_t g = 0; g < P; ++g) {
+                // LESS(p, 0)
+                col[g] = (Load(p + g*PACK_SIZE) < negative_epsilon)
+                         ? idx : col[g];
+            }
+        }
+        for (size_t g = 0; g < P; ++g) {
+            for (size_t i = 0; i < PACK_SIZE; ++i) {
+                j[g*PACK_SIZE + i] = (size_t)col[g][i];
+            }
+        }
+    }
+
+    /**
+     * Choose the row leaving the basis for column j[k] in every lane k, with
+     * the lexicographic rule of PerformPivot. The rule only has to compare
+     * further columns if the minimum ratio x_B(l) / u_l is within EPSILON of
+     * another one; otherwise it picks the minimum, which is found for all
+     * lanes at once. The lexicographic comparison is left to
+     * ChooseRowLexicographic (pivot_rule.h) for the active lanes with such
+     * ties.
+     *
+     * l[k] is 0 if there is no such row.
+     */
+    void chooseRows(const size_t *j, const bool *active, size_t *l)
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        for (size_t k = 0; k < W; ++k) {
+            for (size_t x = 0; x < MM; ++x) {
+                Column_[x*W + k] = this->get(k, x, j[k]);
+            }
+        }
+
+        // ratios x_B(i) / u_i of the rows with u_i > 0, inf for the others,
+        // and their minimum
+        const Pack epsilon = Splat(EPSILON);
+        const Pack infinity = Splat(inf);
+        Pack min[P];
+        for (size_t g = 0; g < P; ++g) {
+            min[g] = infinity;
+        }
+        for (size_t x = 1; x < MM; ++x) {
+            const double *u = &Column_[x*W];
+            const double *b = &Contents_[x*NN*W];
+            double *r = &Ratio_[x*W];
+            for (size_t g = 0; g < P; ++g) {
+                Pack uk = Load(u + g*PACK_SIZE);
+                // LESS(0, u)
+                Pack rk = (uk > epsilon) ? Load(b + g*PACK_SIZE) / uk
+                                         : infinity;
+                Store(r + g*PACK_SIZE, rk);
+                min[g] = (rk < min[g]) ? rk : min[g];
+            }
+        }
+
+        // first row with the minimum ratio and number of rows within EPSILON
+        // of it, row indices and counts kept as double
+        const Pack zero = Splat(0.0);
+        const Pack one = Splat(1.0);
+        Pack row[P];
+        Pack ties[P];
+        for (size_t g = 0; g < P; ++g) {
+            row[g] = zero;
+            ties[g] = zero;
+        }
+        double index = (double)(MM-1);
+        for (size_t x = MM-1; x > 0; --x, index -= 1.0) {
+            const Pack idx = Splat(index);
+            const double *r = &Ratio_[x*W];
+            for (size_t g = 0; g < P; ++g) {
+                Pack rk = Load(r + g*PACK_SIZE);
+                row[g] = (rk == min[g]) ? idx : row[g];
+                // ! LESS(min, r)
+                ties[g] += (min[g] - rk < -epsilon) ? zero : one;
+            }
+        }
+
+        for (size_t g = 0; g < P; ++g) {
+            for (size_t i = 0; i < PACK_SIZE; ++i) {
+                size_t k = g*PACK_SIZE + i;
+                l[k] = (min[g][i] == inf) ? 0 : (size_t)row[g][i];
+                if (active[k] && j[k] != 0 && l[k] != 0 && ties[g][i] > 1.0)
+                    l[k] = ChooseRowLexicographic(LaneView(*this, k), j[k]);
+            }
+        }
+    }
+
+    /**
+     * Let B(l[k]) leave and j[k] enter the basis in every lane k with pivot[k]
+     * set. Expects the entering columns from chooseRows.
+     */
+    void eliminate(const size_t *l, const size_t *j, const bool *pivot)
+    {
+        // gather the normalized pivot rows, 0.0 for masked lanes
+        for (size_t k = 0; k < W; ++k) {
+            if (! pivot[k]) {
+                for (size_t y = 0; y < NN; ++y) {
+                    Pivot_[y*W + k] = 0.0;
+                }
+                continue;
+            }
+            double d = 1/this->get(k, l[k], j[k]);
+            for (size_t y = 0; y < NN; ++y) {
+                Pivot_[y*W + k] = this->get(k, l[k], y) * d;
+            }
+        }
+        // factors -u_x for all rows x except the pivot row, 0.0 for masked
+        // lanes (pivot row -1)
+        alignas(PACK_BYTES) double leaving[W];
+        for (size_t k = 0; k < W; ++k) {
+            leaving[k] = pivot[k] ? (double)l[k] : -1.0;
+        }
+        const Pack zero = Splat(0.0);
+        double index = 0.0;
+        for (size_t x = 0; x < MM; ++x, index += 1.0) {
+            const Pack idx = Splat(index);
+            const double *u = &Column_[x*W];
+            double *f = &Factor_[x*W];
+            for (size_t g = 0; g < P; ++g) {
+                Pack lk = Load(leaving + g*PACK_SIZE);
+                Pack fk = (lk == idx) ? zero : -Load(u + g*PACK_SIZE);
+                Store(f + g*PACK_SIZE, (lk < zero) ? zero : fk);
+            }
+        }
+
+        // row operations for all lanes at once
+        for (size_t x = 0; x < MM; ++x) {
+            Pack f[P];
+            for (size_t g = 0; g < P; ++g) {
+                f[g] = Load(&Factor_[x*W + g*PACK_SIZE]);
+            }
+            double *e = &Contents_[x*NN*W];
+            for (size_t y = 0; y < NN; ++y) {
+                double *ey = e + y*W;
+                const double *p = &Pivot_[y*W];
+                for (size_t g = 0; g < P; ++g) {
+                    Store(ey + g*PACK_SIZE, Load(ey + g*PACK_SIZE)
+                                            + f[g] * Load(p + g*PACK_SIZE));
+                }
+            }
+        }
+
+        // scatter the pivot rows
+        for (size_t k = 0; k < W; ++k) {
+            if (! pivot[k])
+                continue;
+            for (size_t y = 0; y < NN; ++y) {
+                this->set(k, l[k], y, Pivot_[y*W + k]);
+            }
+            Mapping_[l[k]*W + k] = j[k];
+        }
+    }
+};
+
+/**
+ * Solver that keeps W lanes busy with the tableaux tableaux[i] for i in
+ * `queue`, which fit into a FixedMatrix<MM, NN>.
+ *
+ * Every lane runs Phase2 on the artificial problem of its tableau and then on
+ * the tableau itself. The steps of Phase1 in between are performed for the
+ * lane on its own. As soon as a lane is done, it takes the next tableau from
+ * the queue, so lanes only idle once the queue is empty.
+ */
+template <size_t W, size_t MM, size_t NN>
+struct LaneSolver
+{
+    typedef FixedMatrix<MM, NN> Fixed;
+    typedef typename Fixed::Artificial Artificial;
+
+private:
+    struct Lane
+    {
+        Fixed t;         // tableau after Phase1Setup, later for phase 2
+        size_t index;    // index into the tableaux
+        bool artificial; // lane solves the artificial problem
+        bool running;
+
+        Lane() : t(0, 0), index(0), artificial(false), running(false) {}
+    };
+
+    LaneTableau<W, MM, NN + MM - 1> Lanes_;
+    Lane Lane_[W];
+    std::vector<Matrix>& Tableaux_;
+    const std::vector<size_t>& Queue_;
+    size_t Next_;
+    std::vector<bool>& Feasible_;
+    std::vector<double>& Objective_;
+
+    /**
+     * Load the artificial problem of the next tableau into lane k.
+     */
+    void start(size_t k)
+    {
+        Lane& lane = Lane_[k];
+        if (Next_ == Queue_.size()) {
+            lane.running = false;
+            return;
+        }
+        lane.index = Queue_[Next_++];
+        lane.t = Fixed::fromMatrix(Tableaux_[lane.index]);
+        Artificial a = Phase1Setup(lane.t);
+        a.canonicalize();
+        Lanes_.load(k, a);
+        lane.artificial = true;
+        lane.running = true;
+    }
+
+    /**
+     * Continue with lane k after its pivot steps have terminated.
+     */
+    void finish(size_t k, bool unbounded)
+    {
+        Lane& lane = Lane_[k];
+        if (lane.artificial) {
+            Artificial a(lane.t.M, lane.t.N + lane.t.M-1);
+            Lanes_.store(k, a);
+            a.canonicalize();
+            double res = unbounded ? -std::numeric_limits<double>::infinity()
+                                   : -a.get(0, 0);
+            if (Phase1Finish(lane.t, a, res)) {
+                lane.t.canonicalize();
+                Lanes_.load(k, lane.t);
+                lane.artificial = false;
+                return;
+            }
+            Feasible_[lane.index] = false;
+        } else {
+            Lanes_.store(k, lane.t);
+            lane.t.canonicalize();
+            Feasible_[lane.index] = true;
+            Objective_[lane.index] = unbounded
+                ? -std::numeric_limits<double>::infinity()
+                : -lane.t.get(0, 0);
+        }
+        Tableaux_[lane.index] = lane.t.toMatrix();
+        this->start(k);
+    }
+
+public:
+    LaneSolver(std::vector<Matrix>& tableaux, const std::vector<size_t>& queue,
+               std::vector<bool>& feasible, std::vector<double>& objective) :
+        Tableaux_(tableaux), Queue_(queue), Next_(0), Feasible_(feasible),
+        Objective_(objective)
+    {}
+
+    void run(void)
+    {
+        size_t j[W];
+        size_t l[W];
+        bool running[W];
+        bool pivot[W];
+
+        for (size_t k = 0; k < W; ++k) {
+            this->start(k);
+        }
+        for (;;) {
+            size_t num_running = 0;
+            for (size_t k = 0; k < W; ++k) {
+                running[k] = Lane_[k].running;
+                num_running += running[k];
+            }
+            if (num_running == 0)
+                break;
+
+            Lanes_.chooseColumns(j);
+            Lanes_.chooseRows(j, running, l);
+            for (size_t k = 0; k < W; ++k) {
+                pivot[k] = running[k] && j[k] != 0 && l[k] != 0;
+            }
+            Lanes_.eliminate(l, j, pivot);
+
+            for (size_t k = 0; k < W; ++k) {
+                // optimal if j[k] is 0, unbounded if l[k] is 0
+                if (running[k] && ! pivot[k])
+                    this->finish(k, j[k] != 0);
+            }
+        }
+    }
+};
+
+/**
+ * Solve the tableaux of queue with at most W lanes. Lanes without a tableau
+ * still take part in every step, so fewer lanes are used for short queues.
+ */
+template <size_t W, size_t MM, size_t NN>
+static void SolveQueue(std::vector<Matrix>& tableaux,
+                       const std::vector<size_t>& queue,
+                       std::vector<bool>& feasible,
+                       std::vector<double>& objective)
+{
+    if (queue.empty())
+        return;
+    if (W > 4 && queue.size() <= W/2) {
+        SolveQueue<(W > 4 ? W/2 : W), MM, NN>(tableaux, queue, feasible,
+                                              objective);
+        return;
+    }
+    LaneSolver<W, MM, NN>(tableaux, queue, feasible, objective).run();
+}
+
+template <size_t W>
+static void SolveQueues(std::vector<Matrix>& tableaux,
+                        const std::vector<size_t> *queues,
+                        std::vector<bool>& feasible,
+                        std::vector<double>& objective)
+{
+    SolveQueue<W, 4, 8>(tableaux, queues[0], feasible, objective);
+    SolveQueue<W, 8, 16>(tableaux, queues[1], feasible, objective);
+    SolveQueue<W, 16, 32>(tableaux, queues[2], feasible, objective);
+}
+
+void SolveLanes(std::vector<Matrix>& tableaux, size_t lanes,
+                std::vector<bool>& feasible, std::vector<double>& objective)
+{
+    feasible.assign(tableaux.size(), false);
+    objective.assign(tableaux.size(), 0.0);
+
+    // sort the tableaux into the fixed capacities of Solve
+    std::vector<size_t> queues[3];
+    for (size_t v = 0; v < tableaux.size(); ++v) {
+        const Matrix& t = tableaux[v];
+        if (t.M <= 4 && t.N <= 8) {
+            queues[0].push_back(v);
+        } else if (t.M <= 8 && t.N <= 16) {
+            queues[1].push_back(v);
+        } else if (t.M <= 16 && t.N <= 32) {
+            queues[2].push_back(v);
+        } else {
+            double res = 0.0;
+            feasible[v] = Solve(tableaux[v], res);
+            objective[v] = feasible[v] ? res : 0.0;
+        }
+    }
+
+    switch (lanes) {
+    case 4:
+        SolveQueues<4>(tableaux, queues, feasible, objective);
+        break;
+    case 8:
+        SolveQueues<8>(tableaux, queues, feasible, objective);
+        break;
+    case 16:
+        SolveQueues<16>(tableaux, queues, feasible, objective);
+        break;
+    default:
+        assert(false && "unsupported number of lanes!");
+    }
+}
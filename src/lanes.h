@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+#include "matrix.h"
+
+/**
+ * Solve many tableaux like Solve (see impl.h).
+ *
+ * Tableaux that fit into the fixed capacities of Solve are solved in `lanes`
+ * (4, 8 or 16) lanes: the tableaux are stored interleaved, so that pricing,
+ * ratio test and elimination handle the same entry of several lanes with one
+ * SIMD instruction (two lanes with SSE2, four with `make CFG=avx`). If fewer
+ * tableaux of a size are given than there are lanes, fewer lanes are used.
+ * Every lane runs the pivot steps for the artificial problem
+ * of phase 1 and then for phase 2, the remaining steps of phase 1 are
+ * performed for every tableau on its own. A lane that has terminated is
+ * masked out for the current step and refilled with the next tableau. Larger
+ * tableaux are solved with Solve.
+ *
+ * feasible[i] and objective[i] receive the results for tableaux[i], which
+ * contains the final tableau afterwards.
+ */
+void SolveLanes(std::vector<Matrix>& tableaux, size_t lanes,
+                std::vector<bool>& feasible, std::vector<double>& objective);
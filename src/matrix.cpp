@@ -1,8 +1,10 @@
 #include "matrix.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <cassert>
 
+#include "row_reduction.h"
 #include "util.h"
 
 
@@ -33,62 +35,17 @@ void Matrix::addDTimesRowBToRowA(size_t a, size_t b, double d)
 
 void Matrix::eliminate(size_t l, size_t j)
 {
-    // update the mapping from columns to variables
-    this->setMapping(l, j);
-
-    if (verbose) {
-        std::cerr << " ~~> (" << l << ") = (" << l << ") * "
-                  << 1/this->get(l, j) << std::endl;
-    }
-
-    // perform elementary row operations
-    this->multiplyRowBy(l, 1/this->get(l, j));
-
-    for (size_t x = 0; x < this->M; ++x) {
-        if (x == l)
-            continue;
-        if (verbose) {
-            std::cerr << " ~~> (" << x << ") = (" << x << ") + (" << l << ") * "
-                      << -this->get(x, j) << std::endl;
-        }
-        this->addDTimesRowBToRowA(x, l, -this->get(x, j));
-    }
+    Eliminate(*this, l, j);
 }
 
 void Matrix::reducedRowEchelon(bool fail_on_rank)
 {
-    this->canonicalize();
-    for (size_t x = 0; x < this->M; ++x) {
-        if (EQ(this->get(x, x), 0)) {
-            bool success = false;
-            for (size_t y = x; y < this->M; ++y) {
-                if (EQ(this->get(y, x), 0))
-                    continue;
-                this->addDTimesRowBToRowA(x, y, 1.0);
-                success = true;
-            }
-            if (fail_on_rank && ! success) {
-                std::cerr << *this << std::endl;
-            }
-            assert(!fail_on_rank || (success &&
-                   "invalid input for reduced row echelon algorithm!"));
-            if (! success) {
-                continue;
-            }
-        }
-        this->eliminate(x, x);
-    }
+    ReducedRowEchelon(*this, fail_on_rank);
 }
 
 void Matrix::reduceToRank(void)
 {
-    Matrix other(*this);
-    other.reducedRowEchelon(false);
-    for (int x = M-1; x >= 0; --x) {
-        if (EQ(0, other.get(x,x))) {
-            this->removeRow(x);
-        }
-    }
+    ReduceToRank(*this);
 }
 
 void Matrix::removeRow(size_t row)
@@ -139,12 +96,26 @@ std::ostream& operator<< (std::ostream& stream, const Matrix& m)
     return stream;
 }
 
+/**
+ * Check the dimensions read from a stream before allocating a matrix: both
+ * have to be positive and the number of entries must not overflow.
+ */
+static bool IsValidSize(uint64_t m, uint64_t n)
+{
+    static const uint64_t max_entries = std::vector<double>().max_size();
+    return m > 0 && n > 0 && m <= max_entries / n;
+}
+
 Matrix Matrix::fromInput(std::istream& stream)
 {
-    size_t m, n;
+    long m = 0, n = 0;
     bool done = false;
     stream >> m;
     stream >> n;
+    if (stream.fail() || m <= 0 || n <= 0 || ! IsValidSize(m, n)) {
+        stream.setstate(std::ios::failbit);
+        return Matrix(0, 0);
+    }
     Matrix res(m, n);
     for (size_t x = 0; x < res.M; ++x) {
         for (size_t y = 0; y < res.N; ++y) {
@@ -160,6 +131,28 @@ Matrix Matrix::fromInput(std::istream& stream)
     return res;
 }
 
+Matrix Matrix::fromBinary(std::istream& stream)
+{
+    uint64_t size[2] = { 0, 0 };
+    stream.read((char *)size, sizeof(size));
+    if (stream.fail() || ! IsValidSize(size[0], size[1])) {
+        stream.setstate(std::ios::failbit);
+        return Matrix(0, 0);
+    }
+    // read row by row, so that a header larger than the rest of the stream
+    // fails at its end instead of allocating memory for the whole header
+    Matrix res(0, size[1]);
+    for (uint64_t x = 0; x < size[0]; ++x) {
+        res.Contents_.resize((x+1) * res.N);
+        stream.read((char *)&res.Contents_[x * res.N], res.N * sizeof(double));
+        if (stream.fail())
+            return Matrix(0, 0);
+    }
+    res.Mapping_.assign(size[0], 0);
+    res.M = size[0];
+    return res;
+}
+
 Matrix Matrix::fromRandom(size_t m, size_t n, size_t range)
 {
     Matrix res(m, n);
@@ -10,6 +10,12 @@
  */
 struct Matrix
 {
+    // Tableau of the artificial problem in phase 1.
+    typedef Matrix Artificial;
+    // Matrix for inverting the basis matrix in phase 1.
+    typedef Matrix Inverse;
+    typedef std::vector<double> Vector;
+
 private:
     std::vector<double> Contents_;
     std::vector<size_t> Mapping_;
@@ -93,9 +99,22 @@ public:
 
     /**
      * Factory method for creating a matrix from an istream.
+     * If the dimensions are missing or invalid, the failbit of stream is set
+     * and an empty matrix is returned.
      */
     static Matrix fromInput(std::istream& stream);
 
+    /**
+     * Factory method for creating a matrix from a binary istream: the number
+     * of rows and columns as uint64_t, followed by the entries as double in
+     * row-major order (native byte order).
+     * If the sizes are missing or invalid or the stream ends before all
+     * entries, the failbit of stream is set and an empty matrix is returned.
+     * Memory is allocated as the rows are read, but a single row of invalid
+     * size can still throw std::bad_alloc.
+     */
+    static Matrix fromBinary(std::istream& stream);
+
     /**
      * Factory method for creating a randomized mxn matrix with entries in
      * [-range, +range]
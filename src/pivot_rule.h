@@ -0,0 +1,48 @@
+#pragma once
+
+#include <limits>
+
+#include "util.h"
+
+/**
+ * Pivot rules shared by PerformPivot (impl.cpp) and the lane solver
+ * (lanes.cpp). The tableau type T provides get, M, N and a Vector type with
+ * the constructor Vector(n, value) and operator[].
+ */
+
+/**
+ * Choose the row l leaving the basis when j enters it: among the rows with
+ * u_l > 0, the one whose row divided by u_l is lexicographically smallest.
+ * Its first entry is the ratio x_B(l) / u_l of the usual ratio test, and the
+ * further entries break ties, which keeps the simplex method from cycling.
+ *
+ * Returns 0 if there is no such row.
+ */
+template <typename T>
+size_t ChooseRowLexicographic(const T& t, size_t j)
+{
+    size_t l = 0;
+    typename T::Vector min(t.N, std::numeric_limits<double>::infinity());
+
+    for (size_t x = 1; x < t.M; ++x) {
+        double ui = t.get(x, j);
+        if (LESS(0, ui)) {
+            for (size_t y = 0; y < t.N; ++y) {
+                double val = t.get(x, y) / ui;
+                if (LESS(val, min[y])) {
+                    // x is lexico-smaller
+                    for (size_t z = 0; z < t.N; ++z) {
+                        min[z] = t.get(x, z) / ui;
+                    }
+                    l = x;
+                    goto outer;
+                } else if (LESS(min[y], val)) {
+                    // x is lexico-larger
+                    goto outer;
+                }
+            }
+        }
+outer:;
+    }
+    return l;
+}
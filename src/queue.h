@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * Bounded queue for handing items from one pipeline stage to the next.
+ *
+ */
+template <typename T>
+struct BlockingQueue
+{
+private:
+    std::deque<T> Items_;
+    std::mutex Mutex_;
+    std::condition_variable NotEmpty_;
+    std::condition_variable NotFull_;
+    size_t Capacity_;
+    bool Closed_;
+
+public:
+    explicit BlockingQueue(size_t capacity) :
+        Capacity_(capacity), Closed_(false)
+    {}
+
+    /**
+     * Append an item, blocking while the queue is full.
+     */
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(Mutex_);
+        NotFull_.wait(lock, [this] { return Items_.size() < Capacity_; });
+        Items_.push_back(std::move(item));
+        NotEmpty_.notify_one();
+    }
+
+    /**
+     * Take the oldest item, blocking while the queue is empty.
+     *
+     * Returns false if the queue is closed and no items are left.
+     */
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(Mutex_);
+        NotEmpty_.wait(lock, [this] { return Closed_ || !Items_.empty(); });
+        if (Items_.empty())
+            return false;
+        item = std::move(Items_.front());
+        Items_.pop_front();
+        NotFull_.notify_one();
+        return true;
+    }
+
+    /**
+     * Signal that no more items will be pushed.
+     */
+    void close(void)
+    {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        Closed_ = true;
+        NotEmpty_.notify_all();
+    }
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+
+#include "util.h"
+
+/**
+ * Row reduction algorithms shared by Matrix and FixedMatrix (see
+ * fixed_matrix.h). The matrix type T provides get, multiplyRowBy,
+ * addDTimesRowBToRowA, removeRow, canonicalize, setMapping and operator<<.
+ */
+
+/**
+ * Perform the necessary operations such that B(l) leaves the basis and j
+ * enters it.
+ */
+template <typename T>
+void Eliminate(T& t, size_t l, size_t j)
+{
+    // update the mapping from columns to variables
+    t.setMapping(l, j);
+
+    if (verbose) {
+        std::cerr << " ~~> (" << l << ") = (" << l << ") * "
+                  << 1/t.get(l, j) << std::endl;
+    }
+
+    // perform elementary row operations
+    t.multiplyRowBy(l, 1/t.get(l, j));
+
+    for (size_t x = 0; x < t.M; ++x) {
+        if (x == l)
+            continue;
+        if (verbose) {
+            std::cerr << " ~~> (" << x << ") = (" << x << ") + (" << l << ") * "
+                      << -t.get(x, j) << std::endl;
+        }
+        t.addDTimesRowBToRowA(x, l, -t.get(x, j));
+    }
+}
+
+/**
+ * Use elementary row operations to transform t into reduced row echelon form.
+ */
+template <typename T>
+void ReducedRowEchelon(T& t, bool fail_on_rank)
+{
+    t.canonicalize();
+    for (size_t x = 0; x < t.M; ++x) {
+        if (EQ(t.get(x, x), 0)) {
+            bool success = false;
+            for (size_t y = x; y < t.M; ++y) {
+                if (EQ(t.get(y, x), 0))
+                    continue;
+                t.addDTimesRowBToRowA(x, y, 1.0);
+                success = true;
+                break;
+            }
+            if (fail_on_rank && ! success) {
+                std::cerr << t << std::endl;
+            }
+            assert(!fail_on_rank || (success &&
+                   "invalid input for reduced row echelon algorithm!"));
+            if (! success) {
+                continue;
+            }
+        }
+        Eliminate(t, x, x);
+    }
+}
+
+/**
+ * Get the first column of row x of t that is not 0, or t.N for a zero row.
+ */
+template <typename T>
+size_t FirstNonzero(const T& t, size_t x)
+{
+    for (size_t y = 0; y < t.N; ++y) {
+        if (! EQ(t.get(x, y), 0))
+            return y;
+    }
+    return t.N;
+}
+
+/**
+ * Throw away duplicate constraints of t.
+ *
+ * Every constraint row is reduced by the rows kept before it, in row echelon
+ * form with the first nonzero entry of each kept row as its pivot. The row is
+ * redundant if nothing is left of it.
+ */
+template <typename T>
+void ReduceToRank(T& t)
+{
+    T other(t);
+    other.canonicalize();
+    for (size_t x = 1; x < other.M; ) {
+        for (size_t r = 1; r < x; ++r) {
+            size_t p = FirstNonzero(other, r);
+            if (! EQ(other.get(x, p), 0))
+                other.addDTimesRowBToRowA(x, r, -other.get(x, p));
+        }
+        size_t p = FirstNonzero(other, x);
+        if (p == other.N) {
+            t.removeRow(x);
+            other.removeRow(x);
+            continue;
+        }
+        other.multiplyRowBy(x, 1/other.get(x, p));
+        ++x;
+    }
+}
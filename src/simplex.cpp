@@ -1,13 +1,21 @@
 #include <cstring>
 #include <ctime>
 #include <csignal>
+#include <fstream>
+#include <unistd.h>
 
+#include "batch.h"
+#include "generator.h"
 #include "impl.h"
+#include "ipm.h"
+#include "trace.h"
 #include "util.h"
 
 void onAbort(int);
 
+#ifdef SIMPLEX_TRACE
 bool verbose = false;
+#endif
 
 int main(int argc, char *argv[])
 {
@@ -15,12 +23,43 @@ int main(int argc, char *argv[])
 
     // parse cmdline arguments
     bool do_experiments = false;
+    bool do_batch = false;
+    bool do_benchmark = false;
+    bool do_generate = false;
+    bool do_sweep = false;
+    bool use_ipm = false;
+    bool binary = false; // binary tableau format
+    const char *output = nullptr;
+    GeneratorConfig gen = { DENSE, 16, 16, 0.1, 1 };
+    long count = 1; // number of generated instances per size
+    // memory limit for size sweeps, half of the physical memory by default
+    size_t mem_limit = (size_t)sysconf(_SC_PHYS_PAGES)
+                       * (size_t)sysconf(_SC_PAGE_SIZE) / 2;
     long seed = 1; // RNG seed
     long test_factor = 1; // controls size of the experiments
     long num_runs = 100;
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+#ifdef SIMPLEX_TRACE
             verbose = true;
+#else
+            std::cerr << "Verbose output requires a traced build"
+                      << " (make CFG=trace), ignoring " << argv[i]
+                      << std::endl;
+#endif
+        } else if (strcmp(argv[i], "--trace") == 0 && argc > i+1) {
+#ifdef SIMPLEX_TRACE
+            if (! OpenTrace(argv[i+1])) {
+                std::cerr << "Cannot open trace file " << argv[i+1]
+                          << std::endl;
+                exit(1);
+            }
+#else
+            std::cerr << "Pivot traces require a traced build"
+                      << " (make CFG=trace), ignoring " << argv[i]
+                      << std::endl;
+#endif
+            i++;
         } else if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--experiments") == 0) {
             do_experiments = true;
             if (argc > i+1) {
@@ -31,6 +70,47 @@ int main(int argc, char *argv[])
                     seed = time(NULL);
                 }
             }
+        } else if (strcmp(argv[i], "--benchmark") == 0) {
+            do_benchmark = true;
+            if (argc > i+1) {
+                seed = strtol(argv[i+1], nullptr, 10);
+                if (seed != 0) {
+                    i++;
+                } else {
+                    seed = time(NULL);
+                }
+            }
+        } else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--batch") == 0) {
+            do_batch = true;
+        } else if ((strcmp(argv[i], "-g") == 0 || strcmp(argv[i], "--generate") == 0)
+                   && argc > i+1) {
+            do_generate = true;
+            if (! Generator::parseFamily(argv[i+1], gen.family)) {
+                std::cerr << "Unknown instance family " << argv[i+1]
+                          << std::endl;
+                exit(1);
+            }
+            i++;
+        } else if (strcmp(argv[i], "--seed") == 0 && argc > i+1) {
+            seed = strtol(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--size") == 0 && argc > i+1) {
+            gen.size = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--count") == 0 && argc > i+1) {
+            count = strtol(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--density") == 0 && argc > i+1) {
+            gen.density = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--range") == 0 && argc > i+1) {
+            gen.range = strtol(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            do_sweep = true;
+        } else if (strcmp(argv[i], "--mem") == 0 && argc > i+1) {
+            mem_limit = strtoul(argv[++i], nullptr, 10) << 20;
+        } else if (strcmp(argv[i], "--output") == 0 && argc > i+1) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            binary = true;
+        } else if (strcmp(argv[i], "--ipm") == 0) {
+            use_ipm = true;
         } else if (strcmp(argv[i], "--runs") == 0) {
             if (argc > i+1) {
                 num_runs = strtol(argv[i+1], nullptr, 10);
@@ -60,9 +140,22 @@ int main(int argc, char *argv[])
             std::cout << " -h, --help                      show this help"
                       << std::endl;
             std::cout << " -v, --verbose                   show detailed steps"
-                      << std::endl;
+                      << " (traced build only)" << std::endl;
+            std::cout << " --trace <f>                     record pivot steps"
+                      << " to file <f> (traced build only)" << std::endl;
             std::cout << " -e [<s>], --experiments [<s>]   perform experiments"
                       << " with optional RNG seed <s>" << std::endl;
+            std::cout << " --benchmark [<s>]               compare solvers"
+                      << " for small tableaux with optional RNG seed <s>"
+                      << std::endl;
+            std::cout << " -b, --batch                     solve a stream of"
+                      << " tableaux from stdin" << std::endl;
+            std::cout << " -g <f>, --generate <f>          generate instances"
+                      << " of family <f>" << std::endl;
+            std::cout << " --binary                        read/write"
+                      << " tableaux in binary format" << std::endl;
+            std::cout << " --ipm                           use the interior"
+                      << " point method (compare with -e)" << std::endl;
             std::cout << std::endl;
             std::cout << "The experiment configurations can be"
                       << " influenced with the following additional flags:"
@@ -76,17 +169,72 @@ int main(int argc, char *argv[])
             std::cout << " --runs [<s>]                  number of runs"
                       << std::endl;
             std::cout << std::endl;
+            std::cout << "The generated instances can be"
+                      << " influenced with the following additional flags:"
+                      << std::endl;
+            std::cout << " --seed <s>                    RNG seed"
+                      << std::endl;
+            std::cout << " --size <k>                    size parameter"
+                      << " (default 16)" << std::endl;
+            std::cout << " --count <c>                   instances per size"
+                      << " (default 1)" << std::endl;
+            std::cout << " --range <r>                   entries in [-r, r]"
+                      << " (default 16)" << std::endl;
+            std::cout << " --density <d>                 nonzero fraction"
+                      << " for sparse (default 0.1)" << std::endl;
+            std::cout << " --sweep                       double size until"
+                      << " the memory limit is reached" << std::endl;
+            std::cout << " --mem <m>                     memory limit in MiB"
+                      << " for --sweep" << std::endl;
+            std::cout << " --output <f>                  write to file <f>"
+                      << " instead of stdout" << std::endl;
+            std::cout << "Families: dense, sparse, transportation, assignment,"
+                      << " klee-minty, degenerate" << std::endl;
+            std::cout << std::endl;
             std::cout << "If -e is not given, a tableau is expected from stdin."
                       << std::endl;
+            std::cout << "With -b, any number of tableaux is expected from"
+                      << " stdin and one result line is printed per tableau."
+                      << std::endl;
             exit(13);
         }
     }
 
     // actually do something
     if (do_experiments) {
-        PerformExperiments(seed, test_factor, num_runs);
+        PerformExperiments(seed, test_factor, num_runs, use_ipm);
+    } else if (do_benchmark) {
+        PerformBenchmark(seed, num_runs);
+    } else if (do_generate) {
+        std::ios::sync_with_stdio(false);
+        gen.seed = seed;
+        if (gen.size > Generator::maxSize(gen.family)) {
+            std::cerr << "Size " << gen.size << " is too large for "
+                      << Generator::familyName(gen.family) << " (at most "
+                      << Generator::maxSize(gen.family) << ")" << std::endl;
+            exit(1);
+        }
+        if (gen.size < 1 || gen.range < 1 || count < 1) {
+            std::cerr << "Size, range and count have to be at least 1"
+                      << std::endl;
+            exit(1);
+        }
+        if (output != nullptr) {
+            std::ofstream file(output, std::ios::out | std::ios::binary);
+            if (! file) {
+                std::cerr << "Cannot open output file " << output << std::endl;
+                exit(1);
+            }
+            GenerateInstances(gen, count, do_sweep, mem_limit, binary, file);
+        } else {
+            GenerateInstances(gen, count, do_sweep, mem_limit, binary,
+                              std::cout);
+        }
+    } else if (do_batch) {
+        std::ios::sync_with_stdio(false);
+        SolveBatchFromStream(std::cin, std::cout, binary);
     } else {
-        SolveFromStream(std::cin);
+        SolveFromStream(std::cin, binary, use_ipm);
     }
 
     return 0;
@@ -0,0 +1,72 @@
+#include "trace.h"
+
+#ifdef SIMPLEX_TRACE
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Number of events buffered before they are written to the trace file.
+#define TRACE_CHUNK 65536
+
+namespace {
+
+struct PivotEvent
+{
+    size_t run;
+    size_t j;
+    size_t l;
+    double objective;
+};
+
+FILE *trace_file = nullptr;
+size_t trace_run = 0;
+std::vector<PivotEvent> trace_events;
+
+void FlushTrace(void)
+{
+    for (const PivotEvent& e : trace_events) {
+        std::fprintf(trace_file, "%zu %zu %zu %.17g\n",
+                     e.run, e.j, e.l, e.objective);
+    }
+    trace_events.clear();
+}
+
+} // namespace
+
+bool OpenTrace(const char* path)
+{
+    trace_file = std::fopen(path, "w");
+    if (trace_file == nullptr)
+        return false;
+    trace_events.reserve(TRACE_CHUNK);
+    // also write the buffered events if the solver exits early, e.g. from
+    // onAbort after a failed assertion
+    std::atexit(CloseTrace);
+    return true;
+}
+
+void CloseTrace(void)
+{
+    if (trace_file == nullptr)
+        return;
+    FlushTrace();
+    std::fclose(trace_file);
+    trace_file = nullptr;
+}
+
+void TraceRun(void)
+{
+    ++trace_run;
+}
+
+void TracePivot(size_t j, size_t l, double objective)
+{
+    if (trace_file == nullptr)
+        return;
+    trace_events.push_back(PivotEvent{trace_run, j, l, objective});
+    if (trace_events.size() == TRACE_CHUNK)
+        FlushTrace();
+}
+
+#endif
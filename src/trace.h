@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Structured trace of pivot steps, only available in the traced build.
+ *
+ * Every pivot is recorded as one line
+ *   <run> <j> <l> <objective>
+ * where run counts the invocations of Phase2, j is the entering column, l the
+ * leaving row and objective the objective value after the pivot. Events are
+ * buffered in memory and written to the trace file in chunks, and at the
+ * latest when the program exits (also via exit() or an abort).
+ *
+ * Only PerformPivot records events. The lockstep pivots of SolveLanes (see
+ * lanes.h) are neither traced nor counted for the experiments.
+ */
+#ifdef SIMPLEX_TRACE
+
+/**
+ * Start recording pivot events to the file at `path`.
+ *
+ * Returns false if the file cannot be opened.
+ */
+bool OpenTrace(const char* path);
+
+/**
+ * Write out all buffered events and close the trace file. Called
+ * automatically at exit.
+ */
+void CloseTrace(void);
+
+/**
+ * Mark the beginning of a new run of pivot steps.
+ */
+void TraceRun(void);
+
+/**
+ * Record a pivot step.
+ */
+void TracePivot(size_t j, size_t l, double objective);
+
+#else
+
+inline void TraceRun(void) {}
+inline void TracePivot(size_t, size_t, double) {}
+
+#endif
@@ -8,7 +8,12 @@
 // Number of experiments to perform with each configuration.
 #define NUM_TESTS 100
 
-
+// Tracing is only compiled into the traced build (make CFG=trace). Otherwise
+// `verbose` is a constant and every `if (verbose)` block is dead code.
+#ifdef SIMPLEX_TRACE
 extern bool verbose;
+#else
+const bool verbose = false;
+#endif
 
 